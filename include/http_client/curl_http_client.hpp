@@ -3,7 +3,11 @@
 
 #include "http_client/http_client.hpp"
 #include <curl/curl.h>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
+#include <set>
+#include <thread>
 
 namespace http_client {
 
@@ -21,13 +25,60 @@ public:
     void SetTimeout(std::chrono::milliseconds timeout) override;
     std::chrono::milliseconds GetTimeout() const override;
 
+    std::future<void> Preconnect(const std::vector<std::string>& origins) override;
+
+    void SetKeepAlive(std::chrono::seconds interval) override;
+    std::chrono::seconds GetKeepAlive() const override;
+
 private:
     std::future<HTTPResponse> PerformRequest(const std::string& method, const std::string& uri, const std::string& body, const std::vector<std::string>& headers);
     static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* s);
+    static void ShareLock(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+    static void ShareUnlock(CURL* handle, curl_lock_data data, void* userptr);
+
+    struct PreconnectJob {
+        std::vector<std::string> origins;
+        std::promise<void> done;
+    };
+
+    // Upper bound on connect and response time for warm-up requests.
+    static constexpr std::chrono::milliseconds kWarmUpTimeout{5000};
+
+    struct ConnectionSettings {
+        std::chrono::milliseconds timeout;
+        std::chrono::seconds keep_alive;
+        long max_connects;
+    };
+
+    // Runs queued Preconnect jobs and, when keep-alive is set, pings the warmed origins.
+    void WorkerLoop();
+
+    // Sends a HEAD to every origin at once through m_multi. Worker thread only;
+    // runs without m_mutex so requests are never held up by a slow origin.
+    void WarmOrigins(const std::vector<std::string>& origins, ConnectionSettings settings);
+
+    // Snapshot of the options applied to each handle. Caller must hold m_mutex.
+    ConnectionSettings CurrentSettings() const;
+
+    // Applies the shared cache and connection options to a handle.
+    void ConfigureConnection(CURL* handle, const ConnectionSettings& settings) const;
 
+    // m_curl is guarded by m_mutex; m_multi and m_failing_origins belong to the
+    // worker thread. Both use m_share concurrently, guarded by m_share_mutexes.
     CURL* m_curl;
+    CURLM* m_multi;
+    CURLSH* m_share;
+    std::mutex m_share_mutexes[CURL_LOCK_DATA_LAST];
     std::chrono::milliseconds m_timeout;
+    std::chrono::seconds m_keep_alive;
+    unsigned m_keep_alive_generation;
+    std::set<std::string> m_warm_origins;
+    std::set<std::string> m_failing_origins;
+    std::deque<PreconnectJob> m_preconnect_jobs;
+    bool m_stopping;
     mutable std::mutex m_mutex;
+    std::condition_variable m_worker_cv;
+    std::thread m_worker;
 };
 
 } // namespace http_client
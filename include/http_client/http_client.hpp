@@ -22,6 +22,20 @@ public:
 
     virtual void SetTimeout(std::chrono::milliseconds timeout) = 0;
     virtual std::chrono::milliseconds GetTimeout() const = 0;
+
+    // Establishes connections (DNS, TCP, TLS) to each origin on the client's
+    // background thread so later requests to those origins skip connection setup.
+    // Calling it again re-validates the connections. The returned future is ready
+    // once the handshakes finish and may be discarded without blocking. Failures
+    // are logged, not thrown; an unreachable origin stays cold until a later
+    // keep-alive ping reaches it.
+    virtual std::future<void> Preconnect(const std::vector<std::string>& origins) = 0;
+
+    // Pings every preconnected origin with a HEAD request at this interval and
+    // enables TCP keep-alive probes, so warm connections survive idle periods.
+    // The interval must be shorter than the server's idle timeout. Zero disables it.
+    virtual void SetKeepAlive(std::chrono::seconds interval) = 0;
+    virtual std::chrono::seconds GetKeepAlive() const = 0;
 };
 
 } // namespace http_client
@@ -4,14 +4,20 @@
 
 #include "http_client/http_client.hpp"
 #include <httplib.h>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <set>
+#include <thread>
 
 namespace http_client {
 
 class HttplibHTTPClient : public HTTPClient {
 public:
     HttplibHTTPClient();
-    ~HttplibHTTPClient() override = default;
+    ~HttplibHTTPClient() override;
 
     std::future<HTTPResponse> Get(const std::string& uri, const std::vector<std::string>& headers = {}) override;
     std::future<HTTPResponse> Put(const std::string& uri, const std::string& body, const std::vector<std::string>& headers = {}) override;
@@ -22,14 +28,63 @@ public:
     void SetTimeout(std::chrono::milliseconds timeout) override;
     std::chrono::milliseconds GetTimeout() const override;
 
+    std::future<void> Preconnect(const std::vector<std::string>& origins) override;
+
+    void SetKeepAlive(std::chrono::seconds interval) override;
+    std::chrono::seconds GetKeepAlive() const override;
+
 private:
     std::future<HTTPResponse> PerformRequest(const std::string& method, const std::string& uri, 
                                            const std::string& body, const std::vector<std::string>& headers);
     static std::pair<std::string, std::string> ParseURI(const std::string& uri);
 
+    struct CachedClient {
+        std::shared_ptr<httplib::Client> client;
+        // Held by whoever is sending on the client: a request or a warm-up ping.
+        std::shared_ptr<std::mutex> in_use;
+        std::chrono::steady_clock::time_point last_used;
+    };
+
+    struct PreconnectJob {
+        std::vector<std::string> origins;
+        std::promise<void> done;
+    };
+
+    // Idle clients beyond this many (or beyond the number of warmed origins, if
+    // larger) are closed, least recently used first.
+    static constexpr size_t kMaxCachedClients = 16;
+
+    // Upper bound on connect and response time for warm-up requests.
+    static constexpr std::chrono::milliseconds kWarmUpTimeout{5000};
+
     httplib::Client* CreateClient(const std::string& host);
+    // Applies timeouts and socket options to a client. Caller must hold its in_use mutex.
+    static void ConfigureClient(httplib::Client& client, std::chrono::milliseconds timeout,
+                                std::chrono::seconds keep_alive);
+    // Returns the cached client for a host, creating it if needed. Caller must hold m_mutex.
+    CachedClient AcquireClient(const std::string& host);
+    // Closes least recently used clients until `reserve` more fit. Caller must hold m_mutex.
+    void EvictIdleClients(size_t reserve);
+
+    // Runs queued Preconnect jobs and, when keep-alive is set, pings the warmed origins.
+    void WorkerLoop();
+    // Sends a HEAD to every origin's host in parallel. Worker thread only; takes
+    // m_mutex just to look up the clients, never across network I/O.
+    void WarmOrigins(const std::vector<std::string>& origins);
+
+    // Keep-alive clients per scheme and host, so connections outlive a single request.
+    std::map<std::string, CachedClient> m_clients;
     std::chrono::milliseconds m_timeout;
+    std::chrono::seconds m_keep_alive;
+    unsigned m_keep_alive_generation;
+    std::set<std::string> m_warm_origins;
+    // Origins whose last warm-up failed; worker thread only.
+    std::set<std::string> m_failing_origins;
+    std::deque<PreconnectJob> m_preconnect_jobs;
+    bool m_stopping;
     mutable std::mutex m_mutex;
+    std::condition_variable m_worker_cv;
+    std::thread m_worker;
 };
 
 } // namespace http_client
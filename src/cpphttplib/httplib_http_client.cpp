@@ -2,11 +2,23 @@
 #include "http_client/httplib_http_client.hpp"
 #include "http_client/exceptions.hpp"
 #include <spdlog/spdlog.h>
+#include <algorithm>
 #include <regex>
 
 namespace http_client {
 
-HttplibHTTPClient::HttplibHTTPClient() : m_timeout(30000) {}
+HttplibHTTPClient::HttplibHTTPClient() : m_timeout(30000), m_keep_alive(0), m_keep_alive_generation(0), m_stopping(false) {
+    m_worker = std::thread(&HttplibHTTPClient::WorkerLoop, this);
+}
+
+HttplibHTTPClient::~HttplibHTTPClient() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_worker_cv.notify_all();
+    m_worker.join();
+}
 
 std::future<HTTPResponse> HttplibHTTPClient::Get(const std::string& uri, const std::vector<std::string>& headers) {
     return PerformRequest("GET", uri, "", headers);
@@ -38,6 +50,124 @@ std::chrono::milliseconds HttplibHTTPClient::GetTimeout() const {
     return m_timeout;
 }
 
+void HttplibHTTPClient::SetKeepAlive(std::chrono::seconds interval) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_keep_alive = interval;
+        ++m_keep_alive_generation;
+    }
+    m_worker_cv.notify_all();
+}
+
+std::chrono::seconds HttplibHTTPClient::GetKeepAlive() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_keep_alive;
+}
+
+std::future<void> HttplibHTTPClient::Preconnect(const std::vector<std::string>& origins) {
+    std::future<void> done;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_preconnect_jobs.push_back(PreconnectJob{origins, std::promise<void>()});
+        done = m_preconnect_jobs.back().done.get_future();
+    }
+    m_worker_cv.notify_all();
+    return done;
+}
+
+void HttplibHTTPClient::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (!m_stopping) {
+        if (!m_preconnect_jobs.empty()) {
+            PreconnectJob job = std::move(m_preconnect_jobs.front());
+            m_preconnect_jobs.pop_front();
+            m_warm_origins.insert(job.origins.begin(), job.origins.end());
+
+            lock.unlock();
+            WarmOrigins(job.origins);
+            job.done.set_value();
+            lock.lock();
+            continue;
+        }
+
+        if (m_keep_alive.count() == 0 || m_warm_origins.empty()) {
+            m_worker_cv.wait(lock);
+            continue;
+        }
+
+        // Restart the wait whenever SetKeepAlive changes the interval.
+        auto generation = m_keep_alive_generation;
+        bool interrupted = m_worker_cv.wait_for(lock, m_keep_alive, [this, generation]() {
+            return m_stopping || !m_preconnect_jobs.empty() || generation != m_keep_alive_generation;
+        });
+        if (interrupted) {
+            continue;
+        }
+
+        std::vector<std::string> origins(m_warm_origins.begin(), m_warm_origins.end());
+
+        lock.unlock();
+        WarmOrigins(origins);
+        lock.lock();
+    }
+}
+
+void HttplibHTTPClient::WarmOrigins(const std::vector<std::string>& origins) {
+    struct Handshake {
+        std::string origin;
+        std::string path;
+        CachedClient cached;
+    };
+
+    // One HEAD per host; the clients stay in the cache so requests keep using them.
+    std::vector<Handshake> handshakes;
+    std::chrono::milliseconds timeout;
+    std::chrono::seconds keep_alive;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::set<std::string> hosts;
+        for (const auto& origin : origins) {
+            try {
+                auto [host, path] = ParseURI(origin);
+                if (hosts.insert(host).second) {
+                    handshakes.push_back(Handshake{origin, path, AcquireClient(host)});
+                }
+            } catch (const std::exception& e) {
+                spdlog::warn("Preconnect to {} failed: {}", origin, e.what());
+            }
+        }
+        // A slow origin must not hold up the rest of the batch for a full request timeout.
+        timeout = std::min(m_timeout, kWarmUpTimeout);
+        keep_alive = m_keep_alive;
+    }
+
+    std::vector<std::future<bool>> results;
+    for (auto& handshake : handshakes) {
+        results.push_back(std::async(std::launch::async, [&handshake, timeout, keep_alive]() {
+            std::unique_lock<std::mutex> in_use(*handshake.cached.in_use, std::try_to_lock);
+            if (!in_use.owns_lock()) {
+                return true; // a request is using the connection right now
+            }
+            ConfigureClient(*handshake.cached.client, timeout, keep_alive);
+            return handshake.cached.client->Head(handshake.path.c_str()).error() == httplib::Error::Success;
+        }));
+    }
+
+    // Failed origins stay warm-listed and are retried on the next ping; only
+    // log when an origin starts or stops failing.
+    for (size_t i = 0; i < handshakes.size(); ++i) {
+        const auto& origin = handshakes[i].origin;
+        if (!results[i].get()) {
+            if (m_failing_origins.insert(origin).second) {
+                spdlog::warn("Preconnect to {} failed", origin);
+            }
+        } else if (m_failing_origins.erase(origin)) {
+            spdlog::info("Preconnect to {} recovered", origin);
+        }
+    }
+}
+
 std::pair<std::string, std::string> HttplibHTTPClient::ParseURI(const std::string& uri) {
     std::regex uri_regex(R"((https?:\/\/)?([^\/\s]+)(\/.*)?)", std::regex::icase);
     std::smatch matches;
@@ -54,21 +184,74 @@ std::pair<std::string, std::string> HttplibHTTPClient::ParseURI(const std::strin
 
 httplib::Client* HttplibHTTPClient::CreateClient(const std::string& host) {
     auto client = new httplib::Client(host);
-    client->set_connection_timeout(static_cast<double>(m_timeout.count()) / 1000.0);
-    client->set_read_timeout(static_cast<double>(m_timeout.count()) / 1000.0);
-    client->set_write_timeout(static_cast<double>(m_timeout.count()) / 1000.0);
+    client->set_keep_alive(true);
     return client;
 }
 
+void HttplibHTTPClient::ConfigureClient(httplib::Client& client, std::chrono::milliseconds timeout,
+                                        std::chrono::seconds keep_alive) {
+    client.set_connection_timeout(static_cast<double>(timeout.count()) / 1000.0);
+    client.set_read_timeout(static_cast<double>(timeout.count()) / 1000.0);
+    client.set_write_timeout(static_cast<double>(timeout.count()) / 1000.0);
+
+    // Socket options take effect the next time the client opens a connection.
+    int interval = static_cast<int>(keep_alive.count());
+    client.set_socket_options([interval](httplib::socket_t sock) {
+        httplib::default_socket_options(sock);
+        if (interval <= 0) {
+            return;
+        }
+        int yes = 1;
+        setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, reinterpret_cast<const char*>(&yes), sizeof(yes));
+#ifdef TCP_KEEPIDLE
+        setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, reinterpret_cast<const char*>(&interval), sizeof(interval));
+        setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, reinterpret_cast<const char*>(&interval), sizeof(interval));
+#endif
+    });
+}
+
+HttplibHTTPClient::CachedClient HttplibHTTPClient::AcquireClient(const std::string& host) {
+    auto it = m_clients.find(host);
+    if (it == m_clients.end()) {
+        EvictIdleClients(1);
+        CachedClient cached{std::shared_ptr<httplib::Client>(CreateClient(host)), std::make_shared<std::mutex>(), {}};
+        it = m_clients.emplace(host, std::move(cached)).first;
+    }
+    it->second.last_used = std::chrono::steady_clock::now();
+    return it->second;
+}
+
+void HttplibHTTPClient::EvictIdleClients(size_t reserve) {
+    size_t limit = std::max(kMaxCachedClients, m_warm_origins.size());
+    while (!m_clients.empty() && m_clients.size() + reserve > limit) {
+        auto oldest = std::min_element(m_clients.begin(), m_clients.end(), [](const auto& a, const auto& b) {
+            return a.second.last_used < b.second.last_used;
+        });
+        m_clients.erase(oldest);
+    }
+}
+
 std::future<HTTPResponse> HttplibHTTPClient::PerformRequest(
     const std::string& method, const std::string& uri, 
     const std::string& body, const std::vector<std::string>& headers) {
     
     return std::async(std::launch::async, [this, method, uri, body, headers]() {
-        std::lock_guard<std::mutex> lock(m_mutex);
         auto [host, path] = ParseURI(uri);
-        
-        std::unique_ptr<httplib::Client> client(CreateClient(host));
+
+        CachedClient cached;
+        std::chrono::milliseconds timeout;
+        std::chrono::seconds keep_alive;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            cached = AcquireClient(host);
+            timeout = m_timeout;
+            keep_alive = m_keep_alive;
+        }
+
+        // Requests to the same host share one connection, so take turns on it.
+        std::lock_guard<std::mutex> in_use(*cached.in_use);
+        ConfigureClient(*cached.client, timeout, keep_alive);
+        httplib::Client* client = cached.client.get();
         httplib::Headers httplib_headers;
         
         // Convert headers to httplib format
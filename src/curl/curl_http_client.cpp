@@ -6,20 +6,61 @@
 #include <iostream>
 #include <iterator>
 #include <algorithm>
+#include <utility>
 
 namespace http_client {
 
-CurlHTTPClient::CurlHTTPClient() : m_timeout(30000) {
+CurlHTTPClient::CurlHTTPClient() : m_timeout(30000), m_keep_alive(0), m_keep_alive_generation(0), m_stopping(false) {
     m_curl = curl_easy_init();
     if (!m_curl) {
         throw http_client::HTTPException("Failed to initialize libcurl");
     }
+
+    m_multi = curl_multi_init();
+    if (!m_multi) {
+        curl_easy_cleanup(m_curl);
+        throw http_client::HTTPException("Failed to initialize libcurl multi handle");
+    }
+
+    // DNS results, TLS sessions and open connections live in a share so that
+    // connections established by Preconnect are reused by regular requests.
+    m_share = curl_share_init();
+    if (!m_share) {
+        curl_multi_cleanup(m_multi);
+        curl_easy_cleanup(m_curl);
+        throw http_client::HTTPException("Failed to initialize libcurl share");
+    }
+    curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, ShareLock);
+    curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, ShareUnlock);
+    curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    CURLSHcode shared = curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    if (shared != CURLSHE_OK) {
+        spdlog::warn("libcurl cannot share connections ({}); Preconnect will only warm DNS and TLS sessions",
+                     curl_share_strerror(shared));
+    }
+
+    m_worker = std::thread(&CurlHTTPClient::WorkerLoop, this);
 }
 
 CurlHTTPClient::~CurlHTTPClient() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_worker_cv.notify_all();
+    m_worker.join();
+
     if (m_curl) {
         curl_easy_cleanup(m_curl);
     }
+    if (m_multi) {
+        curl_multi_cleanup(m_multi);
+    }
+    if (m_share) {
+        curl_share_cleanup(m_share);
+    }
 }
 
 std::future<HTTPResponse> CurlHTTPClient::Get(const std::string& uri, const std::vector<std::string>& headers) {
@@ -52,13 +93,160 @@ std::chrono::milliseconds CurlHTTPClient::GetTimeout() const {
     return m_timeout;
 }
 
+void CurlHTTPClient::SetKeepAlive(std::chrono::seconds interval) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_keep_alive = interval;
+        ++m_keep_alive_generation;
+    }
+    m_worker_cv.notify_all();
+}
+
+std::chrono::seconds CurlHTTPClient::GetKeepAlive() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_keep_alive;
+}
+
+std::future<void> CurlHTTPClient::Preconnect(const std::vector<std::string>& origins) {
+    std::future<void> done;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_preconnect_jobs.push_back(PreconnectJob{origins, std::promise<void>()});
+        done = m_preconnect_jobs.back().done.get_future();
+    }
+    m_worker_cv.notify_all();
+    return done;
+}
+
+void CurlHTTPClient::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (!m_stopping) {
+        if (!m_preconnect_jobs.empty()) {
+            PreconnectJob job = std::move(m_preconnect_jobs.front());
+            m_preconnect_jobs.pop_front();
+            m_warm_origins.insert(job.origins.begin(), job.origins.end());
+            auto settings = CurrentSettings();
+
+            lock.unlock();
+            WarmOrigins(job.origins, settings);
+            job.done.set_value();
+            lock.lock();
+            continue;
+        }
+
+        if (m_keep_alive.count() == 0 || m_warm_origins.empty()) {
+            m_worker_cv.wait(lock);
+            continue;
+        }
+
+        // Restart the wait whenever SetKeepAlive changes the interval.
+        auto generation = m_keep_alive_generation;
+        bool interrupted = m_worker_cv.wait_for(lock, m_keep_alive, [this, generation]() {
+            return m_stopping || !m_preconnect_jobs.empty() || generation != m_keep_alive_generation;
+        });
+        if (interrupted) {
+            continue;
+        }
+
+        std::vector<std::string> origins(m_warm_origins.begin(), m_warm_origins.end());
+        auto settings = CurrentSettings();
+
+        lock.unlock();
+        WarmOrigins(origins, settings);
+        lock.lock();
+    }
+}
+
+void CurlHTTPClient::WarmOrigins(const std::vector<std::string>& origins, ConnectionSettings settings) {
+    // A slow origin must not hold up the rest of the batch for a full request timeout.
+    settings.timeout = std::min(settings.timeout, kWarmUpTimeout);
+    curl_multi_setopt(m_multi, CURLMOPT_MAXCONNECTS, settings.max_connects);
+
+    std::vector<CURL*> handles;
+    for (const auto& origin : origins) {
+        CURL* handle = curl_easy_init();
+        if (!handle) {
+            spdlog::warn("Preconnect to {} failed: could not initialize libcurl", origin);
+            continue;
+        }
+        ConfigureConnection(handle, settings);
+        curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(settings.timeout.count()));
+        curl_easy_setopt(handle, CURLOPT_URL, origin.c_str());
+        curl_easy_setopt(handle, CURLOPT_NOBODY, 1L);
+        curl_easy_setopt(handle, CURLOPT_PRIVATE, origin.c_str());
+        curl_multi_add_handle(m_multi, handle);
+        handles.push_back(handle);
+    }
+
+    int running = 0;
+    do {
+        CURLMcode mc = curl_multi_perform(m_multi, &running);
+        if (mc == CURLM_OK && running > 0) {
+            mc = curl_multi_poll(m_multi, nullptr, 0, 1000, nullptr);
+        }
+        if (mc != CURLM_OK) {
+            spdlog::warn("Preconnect failed: {}", curl_multi_strerror(mc));
+            break;
+        }
+    } while (running > 0);
+
+    // Failed origins stay warm-listed and are retried on the next ping; only
+    // log when an origin starts or stops failing.
+    int queued = 0;
+    while (CURLMsg* msg = curl_multi_info_read(m_multi, &queued)) {
+        if (msg->msg != CURLMSG_DONE) {
+            continue;
+        }
+        char* origin = nullptr;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &origin);
+        if (msg->data.result != CURLE_OK) {
+            if (m_failing_origins.insert(origin).second) {
+                spdlog::warn("Preconnect to {} failed: {}", origin, curl_easy_strerror(msg->data.result));
+            }
+        } else if (m_failing_origins.erase(origin)) {
+            spdlog::info("Preconnect to {} recovered", origin);
+        }
+    }
+
+    // The connections stay in the share's pool after the handles are gone.
+    for (CURL* handle : handles) {
+        curl_multi_remove_handle(m_multi, handle);
+        curl_easy_cleanup(handle);
+    }
+}
+
+CurlHTTPClient::ConnectionSettings CurlHTTPClient::CurrentSettings() const {
+    // A handle that returns a connection to the shared pool closes the oldest
+    // idle one once the pool exceeds that handle's MAXCONNECTS, so every handle
+    // must allow for all warmed origins plus the one being requested.
+    long max_connects = std::max(5L, static_cast<long>(m_warm_origins.size()) + 1);
+    return ConnectionSettings{m_timeout, m_keep_alive, max_connects};
+}
+
+void CurlHTTPClient::ConfigureConnection(CURL* handle, const ConnectionSettings& settings) const {
+    curl_easy_setopt(handle, CURLOPT_SHARE, m_share);
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, static_cast<long>(settings.timeout.count()));
+    curl_easy_setopt(handle, CURLOPT_MAXCONNECTS, settings.max_connects);
+
+    auto keep_alive = settings.keep_alive;
+    if (keep_alive.count() > 0) {
+        // Pings reuse each warmed connection every interval; let libcurl keep
+        // connections idle that long instead of its 118 second default.
+        curl_easy_setopt(handle, CURLOPT_MAXAGE_CONN, static_cast<long>(std::max<long long>(118, 2 * keep_alive.count())));
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE, static_cast<long>(keep_alive.count()));
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL, static_cast<long>(keep_alive.count()));
+    }
+}
+
 std::future<HTTPResponse> CurlHTTPClient::PerformRequest(const std::string& method, const std::string& uri, const std::string& body, const std::vector<std::string>& headers) {
     return std::async(std::launch::async, [this, method, uri, body, headers]() {
         std::lock_guard<std::mutex> lock(m_mutex);
 
         curl_easy_reset(m_curl);
+        ConfigureConnection(m_curl, CurrentSettings());
         curl_easy_setopt(m_curl, CURLOPT_URL, uri.c_str());
-        curl_easy_setopt(m_curl, CURLOPT_TIMEOUT_MS, static_cast<long>(m_timeout.count()));
 
         struct curl_slist* curl_headers = nullptr;
         for (const auto& header : headers) {
@@ -113,6 +301,16 @@ std::future<HTTPResponse> CurlHTTPClient::PerformRequest(const std::string& meth
     });
 }
 
+void CurlHTTPClient::ShareLock(CURL* /*handle*/, curl_lock_data data, curl_lock_access /*access*/, void* userptr) {
+    auto* self = static_cast<CurlHTTPClient*>(userptr);
+    self->m_share_mutexes[data].lock();
+}
+
+void CurlHTTPClient::ShareUnlock(CURL* /*handle*/, curl_lock_data data, void* userptr) {
+    auto* self = static_cast<CurlHTTPClient*>(userptr);
+    self->m_share_mutexes[data].unlock();
+}
+
 size_t CurlHTTPClient::WriteCallback(void* contents, size_t size, size_t nmemb, std::string* s) {
     size_t newLength = size * nmemb;
     try {
@@ -91,6 +91,49 @@ TEST_F(HTTPClientTest, Timeout) {
     EXPECT_EQ(std::chrono::milliseconds(100), client->GetTimeout());
 }
 
+TEST_F(HTTPClientTest, KeepAlive) {
+    client->SetKeepAlive(std::chrono::seconds(30));
+    EXPECT_EQ(std::chrono::seconds(30), client->GetKeepAlive());
+}
+
+TEST_F(HTTPClientTest, Preconnect) {
+    EXPECT_NO_THROW(client->Preconnect({baseUrl, "http://localhost:12345"}).get());
+
+    auto future = client->Get(baseUrl + "/test");
+    auto response = future.get();
+    EXPECT_EQ(200, response.statusCode);
+}
+
+TEST_F(HTTPClientTest, PreconnectReusesConnection) {
+    client->Preconnect({baseUrl + "/connection"}).get();
+
+    auto response = client->Get(baseUrl + "/connection").get();
+    EXPECT_EQ(200, response.statusCode);
+
+    // The HEAD from Preconnect and this GET arrived on the same connection
+    auto json_response = json::parse(response.body);
+    EXPECT_EQ(2, json_response["requests"]);
+}
+
+TEST_F(HTTPClientTest, PreconnectRevalidatesWarmConnection) {
+    client->Preconnect({baseUrl + "/connection"}).get();
+    client->Preconnect({baseUrl + "/connection"}).get();
+
+    auto response = client->Get(baseUrl + "/connection").get();
+    auto json_response = json::parse(response.body);
+    EXPECT_EQ(3, json_response["requests"]);
+}
+
+TEST_F(HTTPClientTest, KeepAlivePingsWarmConnection) {
+    client->SetKeepAlive(std::chrono::seconds(1));
+    client->Preconnect({baseUrl + "/connection"}).get();
+    std::this_thread::sleep_for(std::chrono::milliseconds(2500));
+
+    auto response = client->Get(baseUrl + "/connection").get();
+    auto json_response = json::parse(response.body);
+    EXPECT_GE(json_response["requests"].get<int>(), 3);
+}
+
 TEST_F(HTTPClientTest, ConnectionError) {
     EXPECT_THROW({
         auto future = client->Get("http://localhost:12345/nonexistent");
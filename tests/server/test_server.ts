@@ -1,9 +1,14 @@
-import { serve } from "https://deno.land/std/http/server.ts";
+import { ConnInfo, serve } from "https://deno.land/std/http/server.ts";
 
 const port = 8080;
 
-async function handler(request: Request): Promise<Response> {
+// Requests seen on each client connection, keyed by the client's port
+const requestsPerConnection = new Map<number, number>();
+
+async function handler(request: Request, connInfo: ConnInfo): Promise<Response> {
   const url = new URL(request.url);
+  const clientPort = (connInfo.remoteAddr as Deno.NetAddr).port;
+  requestsPerConnection.set(clientPort, (requestsPerConnection.get(clientPort) ?? 0) + 1);
   const headers = new Headers({
     "Content-Type": "application/json",
   });
@@ -68,6 +73,17 @@ async function handler(request: Request): Promise<Response> {
         );
       }
 
+      case "/connection": {
+        return new Response(
+          JSON.stringify({
+            status: "success",
+            port: clientPort,
+            requests: requestsPerConnection.get(clientPort),
+          }),
+          { status: 200, headers }
+        );
+      }
+
       case "/slow": {
         await new Promise(resolve => setTimeout(resolve, 2000));
         return new Response(